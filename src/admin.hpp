@@ -0,0 +1,44 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Reserved JSON-RPC methods answered by the proxy itself instead of the node (see tracing.hpp, validation.hpp).
+namespace reverse::admin
+{
+    // admin requests are tiny; anything larger is not parsed looking for them
+    constexpr size_t max_request_bytes{1024};
+
+    // The parsed request if `message` is a JSON-RPC request object for `method`, std::nullopt otherwise.
+    // Never throws; runs on the event loop for every message while an admin method is enabled.
+    inline auto parse_request(std::string_view message, std::string_view method) -> std::optional<nlohmann::json>
+    {
+        if (message.size() > max_request_bytes || message.find(method) == std::string_view::npos)
+        {
+            return std::nullopt;
+        }
+
+        auto request = nlohmann::json::parse(message, nullptr, false);
+        if (request.is_discarded() || !request.is_object())
+        {
+            return std::nullopt;
+        }
+
+        auto const name = request.find("method");
+        if (name == request.end() || !name->is_string() || name->get_ref<std::string const&>() != method)
+        {
+            return std::nullopt;
+        }
+
+        return request;
+    }
+
+    // the response to a request returned by parse_request
+    inline auto make_response(nlohmann::json const& request, nlohmann::json result) -> std::string
+    {
+        auto const id = request.contains("id") ? request.at("id") : nlohmann::json{};
+        return nlohmann::json{{"jsonrpc", "2.0"}, {"id", id}, {"result", std::move(result)}}.dump();
+    }
+} // namespace reverse::admin
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "quill/LogLevel.h"
+#include "tracing.hpp"
+#include "validation.hpp"
+#include <algorithm>
 #include <exception>
 #include <ios>
 #include <nlohmann/json.hpp>
@@ -8,12 +11,14 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <optional>
 #include <pwd.h>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <sys/types.h>
+#include <type_traits>
 #include <unistd.h>
 #include <unordered_map>
 #include <vector>
@@ -42,16 +47,18 @@ namespace reverse::config
     {
         std::vector<proxy> proxies;
         std::string certificates;
+        tracing::options tracing;
+        validation::options validation;
     };
 
-    auto operator<<(std::ostream& os, proxy const& proxy) -> std::ostream&
+    inline auto operator<<(std::ostream& os, proxy const& proxy) -> std::ostream&
     {
         os << "Node=" << proxy.node << ", WSS=" << std::boolalpha << proxy.wss << ", Port=" << proxy.port
            << ", Timeout=" << proxy.timeout;
         return os;
     }
 
-    auto operator<<(std::ostream& os, options const& opt) -> std::ostream&
+    inline auto operator<<(std::ostream& os, options const& opt) -> std::ostream&
     {
         os << "Proxies: " << std::endl;
         for (size_t i{}; i < opt.proxies.size(); i++)
@@ -62,10 +69,21 @@ namespace reverse::config
         {
             os << opt.certificates << std::endl;
         }
+        if (opt.tracing.enabled)
+        {
+            os << "Tracing: SlowMs=" << opt.tracing.slow_ms << ", SampleEvery=" << opt.tracing.sample_every
+               << ", Window=" << opt.tracing.window << ", Admin=" << std::boolalpha << opt.tracing.admin << std::endl;
+        }
+        if (opt.validation.enabled)
+        {
+            os << "Validation: Allow=" << opt.validation.allow.size() << ", Deny=" << opt.validation.deny.size()
+               << ", MaxBytes=" << opt.validation.max_request_bytes << ", MaxPageSize=" << opt.validation.max_page_size
+               << ", Admin=" << std::boolalpha << opt.validation.admin << std::endl;
+        }
         return os;
     }
 
-    auto to_string(options const& opts)
+    inline auto to_string(options const& opts)
     {
         std::ostringstream oss;
         oss << opts;
@@ -91,15 +109,63 @@ namespace reverse::config
 
         inline auto get_config_file() -> std::filesystem::path { return get_config_folder() / "config.json"; }
 
+        // json's get<T> wraps negative or too large numbers into unsigned types silently
+        template <typename T> inline auto get(nlohmann::json const& object, std::string_view key) -> T
+        {
+            auto const& value = object.at(key.data());
+            if constexpr (std::is_unsigned_v<T> && !std::is_same_v<T, bool>)
+            {
+                if (!value.is_number_unsigned() || value.get<uint64_t>() > std::numeric_limits<T>::max())
+                {
+                    throw exception{std::string("Key ") + key.data() + " must be an unsigned integer <= " +
+                                    std::to_string(std::numeric_limits<T>::max())};
+                }
+            }
+            return value.get<T>(); // throws if wrong type
+        }
+
         template <typename T> inline auto get_or_throw(nlohmann::json const& object, std::string_view key) -> T
         {
             if (object.contains(key))
             {
-                return object.at(key.data()).get<T>(); // throws if wrong type
+                return get<T>(object, key);
             }
 
             throw exception{std::string("Key ") + key.data() + " missing"};
         }
+
+        template <typename T> inline auto get_or(nlohmann::json const& object, std::string_view key, T fallback) -> T
+        {
+            if (object.contains(key))
+            {
+                return get<T>(object, key);
+            }
+
+            return fallback;
+        }
+
+        inline auto read_tracing(nlohmann::json const& object) -> tracing::options
+        {
+            tracing::options opts;
+            opts.enabled = get_or(object, "enabled", opts.enabled);
+            opts.slow_ms = get_or(object, "slow_ms", opts.slow_ms);
+            opts.sample_every = get_or(object, "sample_every", opts.sample_every);
+            opts.window = std::min(get_or(object, "window", opts.window), tracing::max_window);
+            opts.admin = get_or(object, "admin", opts.admin);
+            return opts;
+        }
+
+        inline auto read_validation(nlohmann::json const& object) -> validation::options
+        {
+            validation::options opts;
+            opts.enabled = get_or(object, "enabled", opts.enabled);
+            opts.allow = get_or(object, "allow", opts.allow);
+            opts.deny = get_or(object, "deny", opts.deny);
+            opts.max_request_bytes = get_or(object, "max_request_bytes", opts.max_request_bytes);
+            opts.max_page_size = get_or(object, "max_page_size", opts.max_page_size);
+            opts.admin = get_or(object, "admin", opts.admin);
+            return opts;
+        }
     } // namespace detail
 
     inline auto any_wss(options const& opts)
@@ -140,6 +206,18 @@ namespace reverse::config
 
             opts.certificates = detail::get_or_throw<std::string>(json, "certificates");
 
+            // optional; tracing stays disabled if missing
+            if (json.contains("tracing"))
+            {
+                opts.tracing = detail::read_tracing(json.at("tracing"));
+            }
+
+            // optional; requests are forwarded unchecked if missing
+            if (json.contains("validation"))
+            {
+                opts.validation = detail::read_validation(json.at("validation"));
+            }
+
             if (opts.certificates.empty() && any_wss(opts))
             {
                 throw exception{"Key 'certificates' empty but wss requested"};
@@ -151,7 +229,7 @@ namespace reverse::config
         throw exception{"Could not read configuration file"};
     }
 
-    inline auto quill_log_level(options const& opts)
+    inline auto quill_log_level([[maybe_unused]] options const& opts)
     {
         static const std::unordered_map<std::string, quill::LogLevel> mapping = {{"debug", quill::LogLevel::Debug},
                                                                                  {"info", quill::LogLevel::Info},
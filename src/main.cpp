@@ -95,7 +95,7 @@ auto run_until_signalled()
     }
 }
 
-int main(int argc, char** argv)
+int main()
 {
     reverse::config::options config;
     try
@@ -140,6 +140,8 @@ int main(int argc, char** argv)
                                                          .znn_node_url = node_url,
                                                          .znn_node_port = node_port,
                                                          .timeout = proxy.timeout,
+                                                         .tracing = config.tracing,
+                                                         .validation = config.validation,
                                                          .keyfile = keyfile,
                                                          .certfile = certfile}));
     }
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "App.h"
 #include "WebSocket.h"
 #include "WebSocketData.h"
@@ -5,18 +7,26 @@
 #include "libusockets.h"
 #include "quill/detail/LogMacros.h"
 #include "request_handler.hpp"
+#include "tracing.hpp"
+#include "validation.hpp"
 
 #include <cstdint>
 #include <exception>
+#include <functional>
 #include <future>
+#include <optional>
 #include <quill/Quill.h>
 #include <string>
 #include <thread>
+#include <unordered_set>
+#include <vector>
 
 namespace reverse
 {
-    struct unused_per_socket_data
+    struct per_socket_data
     {
+        // traced requests whose response is still buffered due to backpressure; completed in on_drain
+        std::vector<tracing::record> pending_writes;
     };
 
     class proxy_error : std::exception
@@ -32,7 +42,7 @@ namespace reverse
     {
 
         // repeating the definition from uws:Websocket.h here, as it is burried there in a templated class unnecessarily
-        template <bool SSL> using uws_result_t = typename uWS::WebSocket<SSL, true, unused_per_socket_data>::SendStatus;
+        template <bool SSL> using uws_result_t = typename uWS::WebSocket<SSL, true, per_socket_data>::SendStatus;
 
         // used to derive the exact uws_result_t type from an App-template argument
         template <typename App> struct ssl_bool
@@ -56,17 +66,26 @@ namespace reverse
         uint16_t node_port_;
 
         std::thread run_thread_;
+        uWS::Loop* loop_{nullptr};       // set once listening
+        std::function<void()> shutdown_; // closes the listen socket and all connections; run on loop_ only
         us_listen_socket_t* listen_socket_{nullptr};
         std::atomic_bool reject_connections_{false};
 
+        tracing::tracer tracer_;
+        validation::validator validator_;
+
     public:
-        proxy(size_t id, uint16_t port, std::string_view node_url, uint16_t node_port)
-            : id_{id}, port_{port}, node_url_{node_url}, node_port_{node_port}
+        proxy(size_t id, uint16_t port, std::string_view node_url, uint16_t node_port,
+              tracing::options tracing_opts = {}, validation::options validation_opts = {})
+            : id_{id}, port_{port}, node_url_{node_url}, node_port_{node_port}, tracer_{id, tracing_opts},
+              validator_{std::move(validation_opts)}
         {
         }
 
         ~proxy() { close(); }
 
+        auto port() const { return port_; }
+
         proxy(proxy const&) = delete;
         proxy(proxy&& other) = delete;
         proxy& operator=(proxy const&) = delete;
@@ -80,17 +99,20 @@ namespace reverse
                                                                                   .cert_file_name = certfile.c_str()});
         }
 
+        auto validates() const { return validator_.enabled(); }
+        auto rejections() const { return validator_.rejections_json(); }
+
         auto close() -> void
         {
             reject_connections_.store(true);
-            if (listen_socket_)
+            if (loop_)
             {
                 LOG_INFO(quill::get_logger(), "{}: Closing socket", id_);
-                us_listen_socket_close(0, listen_socket_);
+                // uWS is not thread safe; closing has to happen on the proxy's loop, which then runs out of sockets
+                loop_->defer([this] { shutdown_(); });
+                loop_ = nullptr;
             }
 
-            listen_socket_ = nullptr;
-
             if (run_thread_.joinable())
             {
                 LOG_INFO(quill::get_logger(), "{}: Waiting for thread", id_);
@@ -99,6 +121,25 @@ namespace reverse
         }
 
     private:
+        // the reply to one of the enabled admin methods, or an empty string if `message` is none of them
+        auto admin_reply(std::string_view message) const -> std::string
+        {
+            if (tracer_.admin())
+            {
+                if (auto reply = tracing::handle_admin_request(tracer_, message); !reply.empty())
+                {
+                    return reply;
+                }
+            }
+
+            if (validator_.admin())
+            {
+                return validation::handle_admin_request(validator_, message);
+            }
+
+            return {};
+        }
+
         template <typename App> auto start_future_or_throw(uint16_t timeout, uWS::SocketContextOptions opts) -> void
         {
             reject_connections_.store(false);
@@ -124,21 +165,27 @@ namespace reverse
             TApp uws_app{opts};
 
             auto* logger{quill::get_logger()};
+
+            if (uws_app.constructFailed())
+            {
+                startup_signal.set_exception(
+                    std::make_exception_ptr(proxy_error{"Could not create the socket context (certificates?)"}));
+                return;
+            }
+
             std::unique_ptr<handler> node_link;
 
             try
             {
-                size_t connection_timeout_s = 3;
-                node_link = std::make_unique<handler>(node_url_, node_port_, 3);
+                uint16_t connection_timeout_s = 3;
+                node_link = std::make_unique<handler>(node_url_, node_port_, connection_timeout_s);
             }
-            catch (connection_error const& err)
+            catch (connection_error const&)
             {
                 startup_signal.set_exception(std::current_exception());
                 return;
             }
 
-            startup_signal.set_value();
-
             LOG_INFO(logger, "{}: Connected to node @ {}:{}", id_, node_url_, node_port_);
 
             // keep the lambdas more readable by preventing clang-format from putting the brace at the line end
@@ -146,6 +193,9 @@ namespace reverse
             // on-message: forward-copy the received message to the asynchronously called handler
             auto const on_message = [this, &node_link, logger, timeout](auto* ws, std::string_view message,
                                                                         uWS::OpCode opcode) {
+                // all timestamps are taken only if tracing is on
+                auto const received = tracer_.enabled() ? tracing::clock::now() : tracing::clock::time_point{};
+
                 if (reject_connections_)
                 {
                     ws->end(); // send FIN and close socket
@@ -159,15 +209,66 @@ namespace reverse
                     return;
                 }
 
+                // junk is answered from here, before the message is copied or the node is involved
+                auto const reject = [&](validation::rejection const& rejection) {
+                    LOG_DEBUG_NOFN(logger, "{}: Rejecting request from {} ({}): {}", id_,
+                                   ws->getRemoteAddressAsText(), validation::to_string(rejection.why),
+                                   rejection.detail);
+                    if (auto reply = validation::make_error(rejection); !reply.empty())
+                    {
+                        ws->send(reply, uWS::OpCode::TEXT);
+                    }
+                };
+
+                // the size limit applies before anything, including the admin methods, looks at the message
+                if (validator_.enabled())
+                {
+                    if (auto const rejection = validator_.check_size(message); rejection)
+                    {
+                        reject(*rejection);
+                        return;
+                    }
+                }
+
+                // reserved admin methods are answered before the allow- and denylists apply
+                if (tracer_.admin() || validator_.admin())
+                {
+                    if (auto reply = admin_reply(message); !reply.empty())
+                    {
+                        ws->send(reply, uWS::OpCode::TEXT);
+                        return;
+                    }
+                }
+
+                if (validator_.enabled())
+                {
+                    if (auto const rejection = validator_.check(message); rejection)
+                    {
+                        reject(*rejection);
+                        return;
+                    }
+                }
+
                 if (!*node_link)
                 {
                     LOG_ERROR_NOFN(logger, "{}: Handler in invalid state; discarding message", id_);
                     return;
                 }
 
+                using result_t = detail::uws_result_t<detail::ssl_bool<std::decay_t<App>>::ssl>;
+
+                // trace stays null if tracing is off
+                std::optional<tracing::record> record;
+                tracing::record* trace{nullptr};
+                if (tracer_.enabled())
+                {
+                    trace = &record.emplace(tracer_.begin(message.size(), received));
+                }
+
                 std::string msg{message};
-                auto result =
-                    std::async(std::launch::async, [m = std::move(msg), &node_link] { return (*node_link)(m); });
+                if (trace) trace->dispatched = tracing::clock::now();
+                auto result = std::async(std::launch::async,
+                                         [m = std::move(msg), &node_link, trace] { return (*node_link)(m, trace); });
 
                 if (std::future_status::ready != result.wait_for(std::chrono::milliseconds(timeout)))
                 {
@@ -175,6 +276,14 @@ namespace reverse
                                    "{}: TIMEOUT after {}ms awaiting the handler result\n"
                                    "If this happens often increase the timeout value",
                                    id_, timeout);
+                    if (trace)
+                    {
+                        // the future's destructor blocks until the handler is done anyway; waiting
+                        // explicitly keeps the handler thread from writing into the record while it is read
+                        result.wait();
+                        trace->result = tracing::status::timeout;
+                        tracer_.finish(*trace);
+                    }
                     return;
                 }
 
@@ -182,16 +291,51 @@ namespace reverse
 
                 LOG_DEBUG_NOFN(logger, "{}: Received response {}", id_, response);
 
-                using result_t = detail::uws_result_t<detail::ssl_bool<std::decay_t<App>>::ssl>;
-                if (auto code = ws->send(response, uWS::OpCode::TEXT); code != result_t::SUCCESS)
+                auto const code = ws->send(response, uWS::OpCode::TEXT);
+                if (code != result_t::SUCCESS)
                 {
                     LOG_ERROR_NOFN(logger, "{}: SEND returned {}", id_, code);
                 }
+
+                if (trace)
+                {
+                    switch (code)
+                    {
+                    case result_t::SUCCESS:
+                        trace->written = tracing::clock::now();
+                        tracer_.finish(*trace);
+                        break;
+                    case result_t::BACKPRESSURE: ws->getUserData()->pending_writes.push_back(*trace); break;
+                    case result_t::DROPPED:
+                        trace->result = tracing::status::dropped;
+                        tracer_.finish(*trace);
+                        break;
+                    }
+                }
             };
 
             // the other callbacks are mostly just logging handlers
 
-            auto const on_open = [this, logger](auto* ws) {
+            using ws_t = uWS::WebSocket<is_ssl, true, per_socket_data>;
+            std::unordered_set<ws_t*> open_sockets; // only touched on this loop
+
+            shutdown_ = [this, &open_sockets] {
+                if (listen_socket_)
+                {
+                    us_listen_socket_close(is_ssl, listen_socket_);
+                    listen_socket_ = nullptr;
+                }
+
+                // end() runs the close handler synchronously, which erases from open_sockets
+                std::unordered_set<ws_t*> sockets;
+                sockets.swap(open_sockets);
+                for (auto* ws : sockets)
+                {
+                    ws->end(1001, "Proxy shutting down");
+                }
+            };
+
+            auto const on_open = [this, logger, &open_sockets](auto* ws) {
                 if (reject_connections_.load())
                 {
                     LOG_DEBUG_NOFN(logger, "{}: Rejecting connection from {}", id_, ws->getRemoteAddressAsText());
@@ -199,13 +343,22 @@ namespace reverse
                 }
                 else
                 {
+                    open_sockets.insert(ws);
                     LOG_INFO_NOFN(logger, "{}: Connection from {}", id_, ws->getRemoteAddressAsText());
                 }
             };
 
-            auto const on_close = [this, logger](auto* ws, int code, std::string_view message) {
+            auto const on_close = [this, logger, &open_sockets](auto* ws, int code, std::string_view message) {
                 LOG_INFO_NOFN(logger, "{}: CLOSE with remote={}. Code={}, message={}", id_,
                               ws->getRemoteAddressAsText(), code, message);
+                open_sockets.erase(ws);
+
+                // responses still buffered never reached the client
+                for (auto&& trace : ws->getUserData()->pending_writes)
+                {
+                    trace.result = tracing::status::dropped;
+                    tracer_.finish(trace);
+                }
             };
 
             auto const on_drain = [this, logger](auto* ws) {
@@ -213,18 +366,41 @@ namespace reverse
                 if (amount)
                 {
                     LOG_DEBUG_NOFN(logger, "{}: ====> buffered data: {}", id_, amount);
+                    return;
+                }
+
+                auto& pending = ws->getUserData()->pending_writes;
+                if (!pending.empty())
+                {
+                    auto const now = tracing::clock::now();
+                    for (auto&& trace : pending)
+                    {
+                        trace.written = now;
+                        tracer_.finish(trace);
+                    }
+                    pending.clear();
                 }
             };
 
+            // startup succeeds only once the proxy is actually listening; port 0 resolves to the bound port
             auto const on_listen = [&](auto* listen_socket) {
                 if (listen_socket)
                 {
                     listen_socket_ = listen_socket;
+                    port_ = static_cast<uint16_t>(
+                        us_socket_local_port(is_ssl, reinterpret_cast<us_socket_t*>(listen_socket)));
                     LOG_DEBUG_NOFN(logger, "{}: Listening on port {}", id_, port_);
+                    loop_ = uWS::Loop::get();
+                    startup_signal.set_value();
+                }
+                else
+                {
+                    startup_signal.set_exception(
+                        std::make_exception_ptr(proxy_error{"Could not listen on port " + std::to_string(port_)}));
                 }
             };
 
-            using ws_behavior_t = typename TApp::template WebSocketBehavior<unused_per_socket_data>;
+            using ws_behavior_t = typename TApp::template WebSocketBehavior<per_socket_data>;
 
             ws_behavior_t behavior = {
                 .compression = uWS::CompressOptions(uWS::DEDICATED_COMPRESSOR_4KB | uWS::DEDICATED_DECOMPRESSOR),
@@ -242,7 +418,7 @@ namespace reverse
                 .pong = nullptr,
                 .close = on_close};
 
-            uws_app.template ws<unused_per_socket_data>("/*", std::move(behavior)).listen(port_, on_listen).run();
+            uws_app.template ws<per_socket_data>("/*", std::move(behavior)).listen(port_, on_listen).run();
 
             LOG_INFO(logger, "{}: Listener fallthrough", id_);
         }
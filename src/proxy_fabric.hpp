@@ -1,6 +1,10 @@
+#pragma once
+
 #include "proxy.hpp"
 
 #include <cstdint>
+#include <iostream>
+#include <list>
 #include <quill/Quill.h>
 #include <string>
 #include <vector>
@@ -13,6 +17,8 @@ namespace reverse
         std::string znn_node_url;
         uint16_t znn_node_port;
         uint16_t timeout;
+        tracing::options tracing;
+        validation::options validation;
 
         // only needed for wss-proxies
         std::string keyfile;
@@ -35,7 +41,8 @@ namespace reverse
             LOG_INFO(quill::get_logger(), "Starting {}-proxy for {}:{} <-> {}", type == proto::wss ? "wss" : "ws",
                      opts.znn_node_url, opts.znn_node_port, opts.public_port);
 
-            proxies_.emplace_back(proxies_.size(), opts.public_port, opts.znn_node_url, opts.znn_node_port);
+            proxies_.emplace_back(proxies_.size(), opts.public_port, opts.znn_node_url, opts.znn_node_port,
+                                  opts.tracing, opts.validation);
 
             try
             {
@@ -65,6 +72,16 @@ namespace reverse
             {
                 proxy.close();
             }
+
+            size_t id{};
+            for (auto&& proxy : proxies_)
+            {
+                if (proxy.validates())
+                {
+                    LOG_INFO(quill::get_logger(), "{}: Rejected requests {}", id, proxy.rejections().dump());
+                }
+                id++;
+            }
         }
     };
 
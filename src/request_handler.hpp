@@ -2,6 +2,7 @@
 
 #include "connection_ws.hpp" // zenon-sdk-cpp
 #include "quill/detail/LogMacros.h"
+#include "tracing.hpp"
 
 #include <chrono>
 #include <cstdint>
@@ -53,9 +54,11 @@ namespace reverse
             }
         }
 
-        inline auto operator()(std::string request)
+        inline auto operator()(std::string request, tracing::record* trace = nullptr)
         {
+            if (trace) trace->upstream_sent = tracing::clock::now();
             auto response = client_->Send(request);
+            if (trace) trace->upstream_received = tracing::clock::now();
             LOG_DEBUG(logger_, "{} => {}", request, response);
             return response;
             // return client_.Send(request);
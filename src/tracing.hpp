@@ -0,0 +1,199 @@
+#pragma once
+
+#include "admin.hpp"
+#include "quill/detail/LogMacros.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <quill/Quill.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace reverse::tracing
+{
+    using clock = std::chrono::steady_clock;
+
+    struct options
+    {
+        bool enabled{false};
+        uint32_t slow_ms{100};    // requests taking longer than this are always logged
+        uint32_t sample_every{0}; // additionally log every n-th request; 0 disables sampling
+        size_t window{1024};      // amount of recent requests kept for the slowest-requests query
+        bool admin{false};        // answer the admin method on the public socket
+    };
+
+    // upper bounds for the window and the admin query; both are processed on the event loop
+    constexpr size_t max_window{4096};
+    constexpr size_t max_slowest{100};
+
+    // reserved JSON-RPC method answered directly by the proxy if options::admin is set; params: [n]
+    constexpr std::string_view admin_method{"repro.tracing.getSlowestRequests"};
+
+    enum class status : uint8_t
+    {
+        ok,
+        timeout,
+        dropped
+    };
+
+    inline auto to_string(status s) -> std::string_view
+    {
+        switch (s)
+        {
+        case status::ok: return "ok";
+        case status::timeout: return "timeout";
+        case status::dropped: return "dropped";
+        }
+        return "unknown";
+    }
+
+    // monotonic timestamps of a single request on its way through the proxy
+    struct record
+    {
+        uint64_t id{};
+        size_t request_bytes{};
+        status result{status::ok};
+
+        clock::time_point received{};          // on_message entered
+        clock::time_point dispatched{};        // handed to the async handler
+        clock::time_point upstream_sent{};     // handler starts sending to the node
+        clock::time_point upstream_received{}; // node response available in the handler
+        clock::time_point written{};           // response left the socket buffer (on send or on_drain)
+    };
+
+    namespace detail
+    {
+        inline auto us(clock::time_point from, clock::time_point to) -> int64_t
+        {
+            if (from == clock::time_point{} || to == clock::time_point{})
+            {
+                return -1; // phase never reached, e.g. on timeout
+            }
+            return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+        }
+    } // namespace detail
+
+    inline auto total_us(record const& r) -> int64_t
+    {
+        auto const end = r.written != clock::time_point{} ? r.written : r.upstream_received;
+        return detail::us(r.received, end);
+    }
+
+    inline auto to_json(record const& r) -> nlohmann::json
+    {
+        return {{"id", r.id},
+                {"bytes", r.request_bytes},
+                {"status", to_string(r.result)},
+                {"total_us", total_us(r)},
+                {"dispatch_us", detail::us(r.received, r.dispatched)},
+                {"queue_us", detail::us(r.dispatched, r.upstream_sent)},
+                {"node_us", detail::us(r.upstream_sent, r.upstream_received)},
+                {"write_us", detail::us(r.upstream_received, r.written)}};
+    }
+
+    // Collects request records of a single proxy. Only ever used from that proxy's event loop thread,
+    // therefore unsynchronized; the handler thread only writes into the record it was given.
+    class tracer
+    {
+        options opts_;
+        size_t proxy_id_;
+        quill::Logger* logger_;
+
+        uint64_t next_id_{};
+        std::vector<record> recent_; // ring buffer of the last opts_.window completed records
+        size_t head_{};
+
+    public:
+        tracer(size_t proxy_id, options opts) : opts_{opts}, proxy_id_{proxy_id}, logger_{quill::get_logger()}
+        {
+            opts_.window = std::min(opts_.window, max_window);
+            if (opts_.enabled)
+            {
+                recent_.reserve(opts_.window);
+            }
+        }
+
+        auto enabled() const { return opts_.enabled; }
+        auto admin() const { return opts_.enabled && opts_.admin; }
+
+        // `received` is taken when the message arrives, before anything else is done with it
+        auto begin(size_t request_bytes, clock::time_point received) -> record
+        {
+            return {.id = next_id_++, .request_bytes = request_bytes, .received = received};
+        }
+
+        auto finish(record const& r) -> void
+        {
+            auto const total = total_us(r);
+            auto const slow = r.result != status::ok || total >= static_cast<int64_t>(opts_.slow_ms) * 1000;
+            auto const sampled = opts_.sample_every && r.id % opts_.sample_every == 0;
+
+            if (slow || sampled)
+            {
+                // structured record; formatting happens in quill's backend thread
+                LOG_INFO(logger_,
+                         "{}: TRACE id={} status={} bytes={} total_us={} dispatch_us={} queue_us={} node_us={} "
+                         "write_us={} slow={}",
+                         proxy_id_, r.id, to_string(r.result), r.request_bytes, total,
+                         detail::us(r.received, r.dispatched), detail::us(r.dispatched, r.upstream_sent),
+                         detail::us(r.upstream_sent, r.upstream_received), detail::us(r.upstream_received, r.written),
+                         slow);
+            }
+
+            if (opts_.window == 0)
+            {
+                return;
+            }
+
+            if (recent_.size() < opts_.window)
+            {
+                recent_.push_back(r);
+            }
+            else
+            {
+                recent_[head_] = r;
+                head_ = (head_ + 1) % opts_.window;
+            }
+        }
+
+        // the n slowest requests out of the recent window, slowest first; at most max_slowest
+        auto slowest(size_t n) const -> std::vector<record>
+        {
+            std::vector<record> sorted{recent_};
+            n = std::min({n, max_slowest, sorted.size()});
+            std::partial_sort(sorted.begin(), sorted.begin() + n, sorted.end(),
+                              [](auto&& a, auto&& b) { return total_us(a) > total_us(b); });
+            sorted.resize(n);
+            return sorted;
+        }
+    };
+
+    // Answers the admin method if `message` is a request for it. Returns an empty string otherwise,
+    // in which case the message is forwarded to the node as usual.
+    inline auto handle_admin_request(tracer const& tracer, std::string_view message) -> std::string
+    {
+        auto const request = admin::parse_request(message, admin_method);
+        if (!request)
+        {
+            return {};
+        }
+
+        size_t n{10};
+        if (auto params = request->find("params");
+            params != request->end() && params->is_array() && !params->empty() && (*params)[0].is_number_unsigned())
+        {
+            n = (*params)[0].get<size_t>();
+        }
+
+        auto result = nlohmann::json::array();
+        for (auto&& r : tracer.slowest(n))
+        {
+            result.push_back(to_json(r));
+        }
+
+        return admin::make_response(*request, std::move(result));
+    }
+} // namespace reverse::tracing
@@ -0,0 +1,447 @@
+#pragma once
+
+#include "admin.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace reverse::validation
+{
+    struct options
+    {
+        bool enabled{false};
+        std::vector<std::string> allow{}; // if not empty, only these methods are forwarded; "ns.*" matches prefixes
+        std::vector<std::string> deny{};  // never forwarded, takes precedence over allow
+        size_t max_request_bytes{64 * 1024};
+        uint64_t max_page_size{1024}; // upper bound of pageSize and count parameters; the node's own limit
+        bool admin{false};            // answer the admin method on the public socket
+    };
+
+    // reserved JSON-RPC method answered directly by the proxy if options::admin is set
+    constexpr std::string_view admin_method{"repro.validation.getRejections"};
+
+    enum class reason : uint8_t
+    {
+        too_large,
+        parse_error,
+        invalid_request,
+        method_denied,
+        invalid_params,
+        count_ // keep last
+    };
+
+    inline auto to_string(reason r) -> std::string_view
+    {
+        switch (r)
+        {
+        case reason::too_large: return "too_large";
+        case reason::parse_error: return "parse_error";
+        case reason::invalid_request: return "invalid_request";
+        case reason::method_denied: return "method_denied";
+        case reason::invalid_params: return "invalid_params";
+        case reason::count_: break;
+        }
+        return "unknown";
+    }
+
+    // JSON-RPC 2.0 error codes
+    inline auto error_code(reason r) -> int
+    {
+        switch (r)
+        {
+        case reason::parse_error: return -32700;
+        case reason::method_denied: return -32601;
+        case reason::invalid_params: return -32602;
+        default: return -32600;
+        }
+    }
+
+    struct rejection
+    {
+        reason why;
+        nlohmann::json id; // null if the request id could not be determined
+        std::string detail;
+
+        // well-formed requests without id; never answered, not even with an error
+        bool notification{false};
+
+        // set for rejected batches, which are answered with one error per contained request
+        bool batch{false};
+        std::vector<rejection> entries{};
+
+        // batch entries only: the request itself was fine and is rejected because of the others; not counted
+        bool valid{false};
+    };
+
+    namespace detail
+    {
+        enum class param : uint8_t
+        {
+            address,
+            hash,
+            page_index,
+            page_size, // also used for the count of height-based queries
+            height
+        };
+
+        // parameter formats of the queried API methods that take user-controlled addresses, hashes or page sizes.
+        // methods not listed here are only subject to the allow- and denylists.
+        inline auto const& known_methods()
+        {
+            using enum param;
+            static std::unordered_map<std::string_view, std::vector<param>> const methods = {
+                {"ledger.getFrontierAccountBlock", {address}},
+                {"ledger.getAccountInfoByAddress", {address}},
+                {"ledger.getUnconfirmedBlocksByAddress", {address, page_index, page_size}},
+                {"ledger.getUnreceivedBlocksByAddress", {address, page_index, page_size}},
+                {"ledger.getAccountBlockByHash", {hash}},
+                {"ledger.getAccountBlocksByHeight", {address, height, page_size}},
+                {"ledger.getAccountBlocksByPage", {address, page_index, page_size}},
+                {"ledger.getMomentumByHash", {hash}},
+                {"ledger.getMomentumsByHeight", {height, page_size}},
+                {"ledger.getMomentumsByPage", {page_index, page_size}},
+                {"ledger.getDetailedMomentumsByHeight", {height, page_size}},
+                {"embedded.plasma.get", {address}},
+                {"embedded.plasma.getEntriesByAddress", {address, page_index, page_size}},
+                {"embedded.pillar.getAll", {page_index, page_size}},
+                {"embedded.pillar.getDelegatedPillar", {address}},
+                {"embedded.pillar.getDepositedQsr", {address}},
+                {"embedded.pillar.getUncollectedReward", {address}},
+                {"embedded.pillar.getFrontierRewardByPage", {address, page_index, page_size}},
+                {"embedded.sentinel.getByOwner", {address}},
+                {"embedded.sentinel.getAllActive", {page_index, page_size}},
+                {"embedded.sentinel.getDepositedQsr", {address}},
+                {"embedded.sentinel.getUncollectedReward", {address}},
+                {"embedded.sentinel.getFrontierRewardByPage", {address, page_index, page_size}},
+                {"embedded.stake.getEntriesByAddress", {address, page_index, page_size}},
+                {"embedded.stake.getUncollectedReward", {address}},
+                {"embedded.stake.getFrontierRewardByPage", {address, page_index, page_size}},
+                {"embedded.token.getAll", {page_index, page_size}},
+                {"embedded.token.getByOwner", {address, page_index, page_size}},
+                {"embedded.accelerator.getAll", {page_index, page_size}},
+                {"embedded.accelerator.getProjectById", {hash}},
+                {"embedded.accelerator.getPhaseById", {hash}},
+                {"embedded.swap.getAssetsByKeyIdHash", {hash}}};
+            return methods;
+        }
+
+        // bech32 payload without checksum verification; "z1" + 38 characters, all lower- or all uppercase
+        inline auto is_address(nlohmann::json const& value) -> bool
+        {
+            constexpr std::string_view charset{"qpzry9x8gf2tvdw0s3jn54khce6mua7l"};
+
+            if (!value.is_string()) return false;
+            auto const& s = value.get_ref<std::string const&>();
+            if (s.size() != 40) return false;
+
+            auto const lower = std::none_of(s.begin(), s.end(), [](char c) { return c >= 'A' && c <= 'Z'; });
+            auto const upper = std::none_of(s.begin(), s.end(), [](char c) { return c >= 'a' && c <= 'z'; });
+            if (!lower && !upper) return false; // mixed case is invalid bech32
+
+            auto const to_lower = [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; };
+            return to_lower(s[0]) == 'z' && s[1] == '1' && std::all_of(s.begin() + 2, s.end(), [&](char c) {
+                       return charset.find(to_lower(c)) != charset.npos;
+                   });
+        }
+
+        // hex as decoded by the node, which accepts either case
+        inline auto is_hash(nlohmann::json const& value) -> bool
+        {
+            if (!value.is_string()) return false;
+            auto const& s = value.get_ref<std::string const&>();
+            return s.size() == 64 && std::all_of(s.begin(), s.end(), [](char c) {
+                       return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+                   });
+        }
+
+        inline auto matches(std::vector<std::string> const& patterns, std::string_view method) -> bool
+        {
+            return std::any_of(patterns.begin(), patterns.end(), [method](std::string_view p) {
+                if (p.ends_with(".*"))
+                {
+                    return method.starts_with(p.substr(0, p.size() - 1));
+                }
+                return p == method;
+            });
+        }
+    } // namespace detail
+
+    // Checks requests before they are forwarded to the node. Validation runs on the proxy's event loop;
+    // the counters may be read from other threads.
+    class validator
+    {
+        options opts_;
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(reason::count_)> rejections_{};
+
+    public:
+        explicit validator(options opts) : opts_{std::move(opts)} {}
+
+        auto enabled() const { return opts_.enabled; }
+        auto admin() const { return opts_.enabled && opts_.admin; }
+
+        auto rejections(reason r) const
+        {
+            return rejections_[static_cast<size_t>(r)].load(std::memory_order_relaxed);
+        }
+
+        auto rejections_json() const -> nlohmann::json
+        {
+            auto counts = nlohmann::json::object();
+            for (size_t i{}; i < rejections_.size(); i++)
+            {
+                auto const name = std::string{to_string(static_cast<reason>(i))};
+                counts[name] = rejections_[i].load(std::memory_order_relaxed);
+            }
+            return counts;
+        }
+
+        // Only the size limit; cheap enough to run before anything else looks at the message.
+        auto check_size(std::string_view message) -> std::optional<rejection>
+        {
+            return count(validate_size(message));
+        }
+
+        // Returns the rejection if `message` must not be forwarded, std::nullopt otherwise. Never throws,
+        // as it runs on the event loop.
+        auto check(std::string_view message) -> std::optional<rejection>
+        {
+            try
+            {
+                return count(validate(message));
+            }
+            catch (std::exception const&)
+            {
+                return count(rejection{reason::invalid_request, nullptr, "Invalid request"});
+            }
+        }
+
+    private:
+        // every rejected request is counted under its own reason, including each one of a batch
+        auto count(std::optional<rejection> result) -> std::optional<rejection>
+        {
+            if (!result)
+            {
+                return result;
+            }
+
+            if (!result->batch)
+            {
+                rejections_[static_cast<size_t>(result->why)].fetch_add(1, std::memory_order_relaxed);
+                return result;
+            }
+
+            for (auto&& entry : result->entries)
+            {
+                if (!entry.valid)
+                {
+                    rejections_[static_cast<size_t>(entry.why)].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            return result;
+        }
+
+        auto validate_size(std::string_view message) const -> std::optional<rejection>
+        {
+            if (message.size() > opts_.max_request_bytes)
+            {
+                return rejection{reason::too_large, nullptr,
+                                 "Request exceeds " + std::to_string(opts_.max_request_bytes) + " bytes"};
+            }
+            return std::nullopt;
+        }
+
+        auto validate(std::string_view message) const -> std::optional<rejection>
+        {
+            if (auto result = validate_size(message); result)
+            {
+                return result;
+            }
+
+            auto const request = nlohmann::json::parse(message, nullptr, false);
+            if (request.is_discarded())
+            {
+                return rejection{reason::parse_error, nullptr, "Parse error"};
+            }
+
+            if (request.is_array())
+            {
+                if (request.empty())
+                {
+                    return rejection{reason::invalid_request, nullptr, "Empty batch"};
+                }
+
+                return validate_batch(request);
+            }
+
+            return validate_single(request);
+        }
+
+        // A batch is forwarded as a whole or not at all. If any request is invalid, every request of the batch
+        // is answered with an error: invalid ones with their own, the others with a generic invalid request.
+        // Notifications are kept for counting, but never answered.
+        auto validate_batch(nlohmann::json const& batch) const -> std::optional<rejection>
+        {
+            std::optional<rejection> first;
+            std::vector<rejection> entries;
+            entries.reserve(batch.size());
+
+            for (auto&& single : batch)
+            {
+                if (auto result = validate_single(single); result)
+                {
+                    if (!first) first = *result;
+                    entries.push_back(std::move(*result));
+                }
+                else if (single.contains("id"))
+                {
+                    entries.push_back(rejection{.why = reason::invalid_request,
+                                                .id = single.at("id"),
+                                                .detail = "Batch contains invalid requests",
+                                                .valid = true});
+                }
+            }
+
+            if (!first)
+            {
+                return std::nullopt;
+            }
+
+            first->batch = true;
+            first->notification = false;
+            first->entries = std::move(entries);
+            return first;
+        }
+
+        auto validate_single(nlohmann::json const& request) const -> std::optional<rejection>
+        {
+            if (!request.is_object())
+            {
+                return rejection{reason::invalid_request, nullptr, "Invalid request"};
+            }
+
+            auto const id = request.contains("id") ? request.at("id") : nlohmann::json{};
+            auto const version = request.find("jsonrpc");
+            auto const method = request.find("method");
+
+            if (version == request.end() || !version->is_string() || version->get_ref<std::string const&>() != "2.0" ||
+                method == request.end() || !method->is_string())
+            {
+                return rejection{reason::invalid_request, id, "Invalid request"};
+            }
+
+            auto result = validate_method(request, method->get_ref<std::string const&>(), id);
+            if (result)
+            {
+                result->notification = !request.contains("id");
+            }
+            return result;
+        }
+
+        auto validate_method(nlohmann::json const& request, std::string const& name, nlohmann::json const& id) const
+            -> std::optional<rejection>
+        {
+
+            if ((!opts_.allow.empty() && !detail::matches(opts_.allow, name)) || detail::matches(opts_.deny, name))
+            {
+                return rejection{reason::method_denied, id, "The method " + name + " is not available"};
+            }
+
+            auto const params = request.find("params");
+            if (params != request.end() && !params->is_array() && !params->is_object())
+            {
+                return rejection{reason::invalid_params, id, "Invalid params"};
+            }
+
+            auto const known = detail::known_methods().find(name);
+            if (known == detail::known_methods().end())
+            {
+                return std::nullopt;
+            }
+
+            auto const& expected = known->second;
+            if (params == request.end() || !params->is_array() || params->size() != expected.size())
+            {
+                return rejection{reason::invalid_params, id,
+                                 "Expected " + std::to_string(expected.size()) + " positional params"};
+            }
+
+            for (size_t i{}; i < expected.size(); i++)
+            {
+                if (auto error = check_param(expected[i], (*params)[i]); !error.empty())
+                {
+                    return rejection{reason::invalid_params, id, "Param " + std::to_string(i) + ": " + error};
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        auto check_param(detail::param kind, nlohmann::json const& value) const -> std::string
+        {
+            using enum detail::param;
+            switch (kind)
+            {
+            case address: return detail::is_address(value) ? "" : "invalid address";
+            case hash: return detail::is_hash(value) ? "" : "invalid hash";
+            case page_index:
+            case height: return value.is_number_unsigned() ? "" : "expected an unsigned integer";
+            case page_size:
+                if (!value.is_number_unsigned() || value.get<uint64_t>() > opts_.max_page_size)
+                {
+                    return "expected an unsigned integer <= " + std::to_string(opts_.max_page_size);
+                }
+                return "";
+            }
+            return "";
+        }
+    };
+
+    namespace detail
+    {
+        inline auto error_object(rejection const& r) -> nlohmann::json
+        {
+            return {{"jsonrpc", "2.0"}, {"id", r.id}, {"error", {{"code", error_code(r.why)}, {"message", r.detail}}}};
+        }
+    } // namespace detail
+
+    // The JSON-RPC error response for a rejection; an array for batches. Empty if nothing must be answered,
+    // i.e. for notifications and batches consisting of notifications only.
+    inline auto make_error(rejection const& r) -> std::string
+    {
+        if (!r.batch)
+        {
+            return r.notification ? std::string{} : detail::error_object(r).dump();
+        }
+
+        auto response = nlohmann::json::array();
+        for (auto&& entry : r.entries)
+        {
+            if (!entry.notification)
+            {
+                response.push_back(detail::error_object(entry));
+            }
+        }
+        return response.empty() ? std::string{} : response.dump();
+    }
+
+    // Answers the admin method with the rejection counters if `message` is a request for it.
+    // Returns an empty string otherwise.
+    inline auto handle_admin_request(validator const& validator, std::string_view message) -> std::string
+    {
+        auto const request = admin::parse_request(message, admin_method);
+        if (!request)
+        {
+            return {};
+        }
+
+        return admin::make_response(*request, validator.rejections_json());
+    }
+} // namespace reverse::validation
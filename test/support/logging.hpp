@@ -0,0 +1,17 @@
+#pragma once
+
+#include <quill/Quill.h>
+
+namespace reverse::test
+{
+    // the proxies log through quill; its backend has to run once per test binary
+    inline auto start_logging()
+    {
+        static bool const started = [] {
+            quill::start();
+            quill::get_logger()->set_log_level(quill::LogLevel::Warning);
+            return true;
+        }();
+        return started;
+    }
+} // namespace reverse::test
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "App.h"
+#include "libusockets.h"
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+namespace reverse::test
+{
+    // Local replacement for a Zenon node: answers every JSON-RPC request with its method name as result.
+    // The method "test.sleep" with params [ms] delays the answer, blocking the node for that duration.
+    class stand_in_node
+    {
+        struct socket_data
+        {
+        };
+        using ws_t = uWS::WebSocket<false, true, socket_data>;
+
+        std::thread run_thread_;
+        uWS::Loop* loop_{nullptr};
+        us_listen_socket_t* listen_socket_{nullptr};
+        std::unordered_set<ws_t*> sockets_; // only touched from the loop thread
+        uint16_t port_{};
+
+    public:
+        stand_in_node()
+        {
+            std::promise<void> listening;
+            auto started = listening.get_future();
+            run_thread_ = std::thread(&stand_in_node::run, this, std::move(listening));
+
+            try
+            {
+                started.get();
+            }
+            catch (...)
+            {
+                run_thread_.join();
+                throw;
+            }
+        }
+
+        ~stand_in_node() { stop(); }
+
+        stand_in_node(stand_in_node const&) = delete;
+        stand_in_node& operator=(stand_in_node const&) = delete;
+
+        auto port() const { return port_; }
+        auto url() const -> std::string { return "ws://127.0.0.1"; }
+
+        auto stop() -> void
+        {
+            if (!run_thread_.joinable()) return;
+
+            // uWS is not thread safe; closing has to happen on the loop itself
+            loop_->defer([this] {
+                if (listen_socket_) us_listen_socket_close(0, listen_socket_);
+                listen_socket_ = nullptr;
+
+                // close() calls the close handler synchronously, which erases from sockets_
+                std::unordered_set<ws_t*> sockets;
+                sockets.swap(sockets_);
+                for (auto* ws : sockets) ws->close();
+            });
+            run_thread_.join();
+        }
+
+        static auto answer(std::string_view message) -> std::string
+        {
+            auto const request = nlohmann::json::parse(message, nullptr, false);
+            if (request.is_discarded() || !request.is_object())
+            {
+                return R"({"jsonrpc":"2.0","id":null,"error":{"code":-32700,"message":"parse error"}})";
+            }
+
+            auto const method = request.value("method", "");
+            if (method == "test.sleep")
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(request.at("params").at(0).get<int>()));
+            }
+
+            auto const id = request.contains("id") ? request.at("id") : nlohmann::json{};
+            return nlohmann::json{{"jsonrpc", "2.0"}, {"id", id}, {"result", method}}.dump();
+        }
+
+    private:
+        auto run(std::promise<void> listening) -> void
+        {
+            loop_ = uWS::Loop::get();
+
+            uWS::App app;
+            app.ws<socket_data>("/*", {.open = [this](auto* ws) { sockets_.insert(ws); },
+                                       .message = [](auto* ws, std::string_view message,
+                                                     uWS::OpCode) { ws->send(answer(message), uWS::OpCode::TEXT); },
+                                       .close = [this](auto* ws, int, std::string_view) { sockets_.erase(ws); }})
+                .listen(0, [&](auto* listen_socket) {
+                    if (!listen_socket)
+                    {
+                        listening.set_exception(std::make_exception_ptr(std::runtime_error("node listen failed")));
+                        return;
+                    }
+                    listen_socket_ = listen_socket;
+                    port_ = static_cast<uint16_t>(
+                        us_socket_local_port(0, reinterpret_cast<us_socket_t*>(listen_socket)));
+                    listening.set_value();
+                })
+                .run();
+        }
+    };
+} // namespace reverse::test
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace reverse::test
+{
+    // Minimal blocking websocket client for the tests. Unlike the sdk connector it can wait for a response
+    // with a deadline, which is required to observe requests the proxy never answers.
+    class ws_client
+    {
+        int fd_{-1};
+        std::string buffer_; // bytes read past the current frame
+
+    public:
+        explicit ws_client(uint16_t port, std::string_view host = "127.0.0.1")
+        {
+            fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (fd_ < 0) throw std::runtime_error("socket() failed");
+
+            int nodelay{1};
+            ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            ::inet_pton(AF_INET, std::string{host}.c_str(), &addr.sin_addr);
+
+            if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+            {
+                ::close(fd_);
+                fd_ = -1;
+                throw std::runtime_error("connect() to port " + std::to_string(port) + " failed");
+            }
+
+            handshake(std::string{host} + ":" + std::to_string(port));
+        }
+
+        ~ws_client() { close(); }
+
+        ws_client(ws_client const&) = delete;
+        ws_client& operator=(ws_client const&) = delete;
+
+        auto connected() const { return fd_ >= 0; }
+
+        auto send(std::string_view text) -> void { send_frame(0x1, text); }
+
+        // the next text message, or std::nullopt if none arrived in time or the server closed the connection
+        auto receive(std::chrono::milliseconds timeout = std::chrono::seconds(2)) -> std::optional<std::string>
+        {
+            auto const deadline = std::chrono::steady_clock::now() + timeout;
+
+            while (connected())
+            {
+                std::string header;
+                if (!read_exact(header, 2, deadline)) return std::nullopt;
+
+                auto const opcode = static_cast<uint8_t>(header[0]) & 0x0f;
+                uint64_t length = static_cast<uint8_t>(header[1]) & 0x7f;
+
+                if (length >= 126)
+                {
+                    std::string extended;
+                    if (!read_exact(extended, length == 126 ? 2 : 8, deadline)) return std::nullopt;
+                    length = 0;
+                    for (auto c : extended) length = (length << 8) | static_cast<uint8_t>(c);
+                }
+
+                std::string payload;
+                if (!read_exact(payload, length, deadline)) return std::nullopt;
+
+                switch (opcode)
+                {
+                case 0x1: return payload;
+                case 0x8: close(); return std::nullopt;
+                case 0x9: send_frame(0xa, payload); break; // answer pings
+                default: break;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        auto request(std::string_view text, std::chrono::milliseconds timeout = std::chrono::seconds(2))
+        {
+            send(text);
+            return receive(timeout);
+        }
+
+        auto close() -> void
+        {
+            if (fd_ < 0) return;
+
+            ::shutdown(fd_, SHUT_RDWR);
+            ::close(fd_);
+            fd_ = -1;
+        }
+
+    private:
+        auto handshake(std::string const& host) -> void
+        {
+            write_all("GET / HTTP/1.1\r\n"
+                      "Host: " + host + "\r\n"
+                      "Upgrade: websocket\r\n"
+                      "Connection: Upgrade\r\n"
+                      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                      "Sec-WebSocket-Version: 13\r\n\r\n");
+
+            auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+            std::string response;
+            while (response.find("\r\n\r\n") == std::string::npos)
+            {
+                std::string chunk;
+                if (!read_exact(chunk, 1, deadline)) throw std::runtime_error("websocket handshake timed out");
+                response += chunk;
+            }
+
+            if (response.find(" 101 ") == std::string::npos)
+            {
+                close();
+                throw std::runtime_error("websocket upgrade rejected");
+            }
+        }
+
+        auto send_frame(uint8_t opcode, std::string_view payload) -> void
+        {
+            constexpr std::array<uint8_t, 4> mask{0x12, 0x34, 0x56, 0x78}; // clients must mask
+
+            std::string frame;
+            frame.push_back(static_cast<char>(0x80 | opcode));
+
+            if (payload.size() < 126)
+            {
+                frame.push_back(static_cast<char>(0x80 | payload.size()));
+            }
+            else if (payload.size() <= 0xffff)
+            {
+                frame.push_back(static_cast<char>(0x80 | 126));
+                for (int shift = 8; shift >= 0; shift -= 8) frame.push_back(static_cast<char>(payload.size() >> shift));
+            }
+            else
+            {
+                frame.push_back(static_cast<char>(0x80 | 127));
+                for (int shift = 56; shift >= 0; shift -= 8)
+                {
+                    frame.push_back(static_cast<char>(static_cast<uint64_t>(payload.size()) >> shift));
+                }
+            }
+
+            frame.append(mask.begin(), mask.end());
+            for (size_t i{}; i < payload.size(); i++)
+            {
+                frame.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+            }
+
+            write_all(frame);
+        }
+
+        auto write_all(std::string_view data) -> void
+        {
+            while (!data.empty() && connected())
+            {
+                auto const written = ::send(fd_, data.data(), data.size(), MSG_NOSIGNAL);
+                if (written <= 0)
+                {
+                    close();
+                    return;
+                }
+                data.remove_prefix(static_cast<size_t>(written));
+            }
+        }
+
+        auto read_exact(std::string& out, size_t amount, std::chrono::steady_clock::time_point deadline) -> bool
+        {
+            while (buffer_.size() < amount)
+            {
+                auto const remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now());
+                if (!connected() || remaining.count() <= 0) return false;
+
+                pollfd pfd{.fd = fd_, .events = POLLIN, .revents = 0};
+                if (::poll(&pfd, 1, static_cast<int>(remaining.count())) <= 0) return false;
+
+                std::array<char, 64 * 1024> chunk;
+                auto const received = ::recv(fd_, chunk.data(), chunk.size(), 0);
+                if (received <= 0)
+                {
+                    close();
+                    return false;
+                }
+                buffer_.append(chunk.data(), static_cast<size_t>(received));
+            }
+
+            out = buffer_.substr(0, amount);
+            buffer_.erase(0, amount);
+            return true;
+        }
+    };
+} // namespace reverse::test
@@ -0,0 +1,148 @@
+#include "config.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+    // points HOME to a fresh temporary folder for the lifetime of the fixture
+    class temporary_home
+    {
+        std::filesystem::path home_;
+        std::string previous_;
+
+    public:
+        temporary_home()
+            : home_{std::filesystem::temp_directory_path() / ("znn-repro-test-" + std::to_string(getpid()))}
+        {
+            if (auto const* home = getenv("HOME"); home) previous_ = home;
+            std::filesystem::create_directories(home_);
+            setenv("HOME", home_.c_str(), 1);
+        }
+
+        ~temporary_home()
+        {
+            setenv("HOME", previous_.c_str(), 1);
+            std::filesystem::remove_all(home_);
+        }
+
+        auto write_config(std::string const& content) const
+        {
+            std::filesystem::create_directories(reverse::config::detail::get_config_folder());
+            std::ofstream{reverse::config::detail::get_config_file()} << content;
+        }
+    };
+
+    constexpr auto valid_config = R"({
+        "proxies": [
+            {"node": "ws://localhost:35998", "wss": false, "port": 8001, "timeout": 20},
+            {"node": "ws://127.0.0.1:35999", "wss": false, "port": 8002, "timeout": 120}
+        ],
+        "certificates": ""
+    })";
+} // namespace
+
+TEST_CASE("reading a valid configuration", "[config]")
+{
+    temporary_home home;
+    home.write_config(valid_config);
+
+    auto const opts = reverse::config::read_config_file();
+
+    REQUIRE(opts.proxies.size() == 2);
+    CHECK(opts.proxies[0].node == "ws://localhost:35998");
+    CHECK(opts.proxies[1].port == 8002);
+    CHECK(opts.proxies[1].timeout == 120);
+    CHECK_FALSE(reverse::config::any_wss(opts));
+    CHECK_FALSE(opts.tracing.enabled);
+    CHECK_FALSE(opts.validation.enabled);
+
+    CHECK(reverse::config::node_url(opts.proxies[0]) == "ws://localhost");
+    CHECK(reverse::config::node_port(opts.proxies[0]) == 35998);
+}
+
+TEST_CASE("reading optional tracing and validation sections", "[config]")
+{
+    temporary_home home;
+    home.write_config(R"({
+        "proxies": [{"node": "ws://localhost:35998", "wss": false, "port": 8001, "timeout": 20}],
+        "certificates": "",
+        "tracing": {"enabled": true, "slow_ms": 5, "admin": true},
+        "validation": {"enabled": true, "allow": ["ledger.*"], "max_page_size": 50}
+    })");
+
+    auto const opts = reverse::config::read_config_file();
+
+    CHECK(opts.tracing.enabled);
+    CHECK(opts.tracing.slow_ms == 5);
+    CHECK(opts.tracing.sample_every == reverse::tracing::options{}.sample_every);
+    CHECK(opts.tracing.admin);
+
+    CHECK(opts.validation.enabled);
+    CHECK(opts.validation.allow == std::vector<std::string>{"ledger.*"});
+    CHECK(opts.validation.deny.empty());
+    CHECK(opts.validation.max_page_size == 50);
+}
+
+TEST_CASE("invalid configurations are rejected", "[config]")
+{
+    temporary_home home;
+
+    SECTION("missing file")
+    {
+        CHECK_THROWS_AS(reverse::config::read_config_file(), reverse::config::exception);
+    }
+
+    SECTION("missing proxy key")
+    {
+        home.write_config(R"({"proxies": [{"node": "ws://localhost:35998", "wss": false, "port": 8001}],
+                              "certificates": ""})");
+        CHECK_THROWS_AS(reverse::config::read_config_file(), reverse::config::exception);
+    }
+
+    SECTION("missing certificates key")
+    {
+        home.write_config(R"({"proxies": []})");
+        CHECK_THROWS_AS(reverse::config::read_config_file(), reverse::config::exception);
+    }
+
+    SECTION("wss without certificates")
+    {
+        home.write_config(R"({"proxies": [{"node": "ws://localhost:35998", "wss": true, "port": 443, "timeout": 20}],
+                              "certificates": ""})");
+        CHECK_THROWS_AS(reverse::config::read_config_file(), reverse::config::exception);
+    }
+
+    SECTION("wrong value type")
+    {
+        home.write_config(R"({"proxies": [{"node": "ws://localhost:35998", "wss": "no", "port": 8001, "timeout": 20}],
+                              "certificates": ""})");
+        CHECK_THROWS(reverse::config::read_config_file());
+    }
+
+    SECTION("negative unsigned value")
+    {
+        home.write_config(R"({"proxies": [], "certificates": "", "tracing": {"enabled": true, "slow_ms": -1}})");
+        CHECK_THROWS_AS(reverse::config::read_config_file(), reverse::config::exception);
+
+        home.write_config(R"({"proxies": [], "certificates": "", "validation": {"max_page_size": -1}})");
+        CHECK_THROWS_AS(reverse::config::read_config_file(), reverse::config::exception);
+    }
+
+    SECTION("unsigned value out of range")
+    {
+        home.write_config(R"({"proxies": [{"node": "ws://localhost:35998", "wss": false, "port": 65536, "timeout": 20}],
+                              "certificates": ""})");
+        CHECK_THROWS_AS(reverse::config::read_config_file(), reverse::config::exception);
+    }
+
+    SECTION("malformed json")
+    {
+        home.write_config(R"({"proxies": [)");
+        CHECK_THROWS(reverse::config::read_config_file());
+    }
+}
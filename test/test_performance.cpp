@@ -0,0 +1,189 @@
+#include "proxy.hpp"
+#include "validation.hpp"
+
+#include "support/logging.hpp"
+#include "support/stand_in_node.hpp"
+#include "support/ws_client.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+// Regression tests for the message path. Tracing and validation are measured against the plain message path in the
+// same run, alternating between both in every pass, so that the limits below hold on any machine and load changes
+// affect both sides alike.
+
+namespace
+{
+    using steady = std::chrono::steady_clock;
+
+    // roundtrip throughput and median latency with tracing or validation enabled, relative to the plain path
+    constexpr double min_throughput_ratio{0.85};
+    constexpr double max_latency_ratio{1.25};
+
+    // a validated request costs a single parse plus the checks; relative to parsing it only
+    constexpr double max_validation_ratio{1.75};
+
+    constexpr size_t passes{7};
+
+    auto median(std::vector<double> values)
+    {
+        REQUIRE_FALSE(values.empty());
+        std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+        return values[values.size() / 2];
+    }
+
+    auto percentile(std::vector<int64_t> samples, double p) -> int64_t
+    {
+        REQUIRE_FALSE(samples.empty());
+        auto const n = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+        std::nth_element(samples.begin(), samples.begin() + n, samples.end());
+        return samples[n];
+    }
+
+    auto make_request(int id)
+    {
+        return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) + R"(,"method":"ledger.getAccountBlocksByPage",)" +
+               R"("params":["z1qqjnwjjpnue8xmmpanz6csze6tcmtzzdtfsww7", 0, 10]})";
+    }
+
+    struct measurement
+    {
+        double requests_per_s;
+        double p50_us;
+    };
+
+    // one pass of clients * requests sequential roundtrips per client through a fresh proxy
+    auto measure_roundtrip(reverse::tracing::options tracing_opts, reverse::validation::options validation_opts)
+        -> measurement
+    {
+        constexpr int clients = 4;
+        constexpr int warmup = 100;
+        constexpr int requests = 500;
+
+        reverse::test::stand_in_node node;
+        reverse::proxy proxy{0, 0, node.url(), node.port(), tracing_opts, validation_opts};
+        proxy.ws(200);
+
+        std::vector<std::future<std::vector<int64_t>>> runs;
+        std::promise<void> go;
+        auto const started = go.get_future().share();
+
+        for (int c = 0; c < clients; c++)
+        {
+            runs.push_back(std::async(std::launch::async, [&proxy, started] {
+                reverse::test::ws_client client{proxy.port()};
+                for (int r = 0; r < warmup; r++) client.request(make_request(r));
+                started.wait();
+
+                std::vector<int64_t> latencies;
+                latencies.reserve(requests);
+                for (int r = 0; r < requests; r++)
+                {
+                    auto const sent = steady::now();
+                    if (!client.request(make_request(r))) break;
+                    auto const latency = std::chrono::duration_cast<std::chrono::microseconds>(steady::now() - sent);
+                    latencies.push_back(latency.count());
+                }
+                return latencies;
+            }));
+        }
+
+        auto const start = steady::now();
+        go.set_value();
+
+        std::vector<int64_t> latencies;
+        for (auto&& run : runs)
+        {
+            auto const client_latencies = run.get();
+            latencies.insert(latencies.end(), client_latencies.begin(), client_latencies.end());
+        }
+
+        auto const elapsed = std::chrono::duration<double>(steady::now() - start).count();
+        proxy.close();
+
+        REQUIRE(latencies.size() == static_cast<size_t>(clients * requests));
+
+        return {.requests_per_s = static_cast<double>(latencies.size()) / elapsed,
+                .p50_us = static_cast<double>(percentile(latencies, 0.5))};
+    }
+
+    // medians of interleaved passes through the plain path and through a proxy with the given options
+    auto compare_roundtrip(reverse::tracing::options tracing_opts, reverse::validation::options validation_opts)
+    {
+        std::vector<double> plain_rps, plain_p50, rps, p50;
+        for (size_t i{}; i < passes; i++)
+        {
+            auto const plain = measure_roundtrip({}, {});
+            plain_rps.push_back(plain.requests_per_s);
+            plain_p50.push_back(plain.p50_us);
+
+            auto const other = measure_roundtrip(tracing_opts, validation_opts);
+            rps.push_back(other.requests_per_s);
+            p50.push_back(other.p50_us);
+        }
+
+        auto const throughput = median(rps) / median(plain_rps);
+        auto const latency = median(p50) / median(plain_p50);
+
+        INFO("requests/s: " << median(rps) << " vs. " << median(plain_rps) << " plain; p50 us: " << median(p50)
+                            << " vs. " << median(plain_p50) << " plain");
+        CHECK(throughput >= min_throughput_ratio);
+        CHECK(latency <= max_latency_ratio);
+    }
+
+    // tracing on, but nothing logged: measures the timestamps and the ring buffer
+    reverse::tracing::options const tracing_on{.enabled = true, .slow_ms = 60'000, .sample_every = 0};
+    reverse::validation::options const validation_on{.enabled = true, .allow = {"ledger.*", "embedded.*"}};
+} // namespace
+
+TEST_CASE("roundtrip with tracing", "[perf]")
+{
+    reverse::test::start_logging();
+    compare_roundtrip(tracing_on, {});
+}
+
+TEST_CASE("roundtrip with validation", "[perf]")
+{
+    reverse::test::start_logging();
+    compare_roundtrip({}, validation_on);
+}
+
+TEST_CASE("roundtrip with tracing and validation", "[perf]")
+{
+    reverse::test::start_logging();
+    compare_roundtrip(tracing_on, validation_on);
+}
+
+TEST_CASE("edge validation costs little more than parsing the request", "[perf]")
+{
+    reverse::validation::validator validator{validation_on};
+    auto const request = make_request(1);
+
+    constexpr int iterations = 20000;
+
+    auto const time = [&](auto&& f) {
+        auto const start = steady::now();
+        for (int i = 0; i < iterations; i++) f();
+        return std::chrono::duration<double>(steady::now() - start).count();
+    };
+
+    size_t rejected{}, discarded{};
+    std::vector<double> parse_s, check_s;
+    for (size_t i{}; i < passes; i++)
+    {
+        parse_s.push_back(time([&] { discarded += nlohmann::json::parse(request, nullptr, false).is_discarded(); }));
+        check_s.push_back(time([&] { rejected += validator.check(request).has_value(); }));
+    }
+
+    REQUIRE(rejected == 0);
+    REQUIRE(discarded == 0);
+
+    INFO("parse: " << median(parse_s) << "s, check: " << median(check_s) << "s for " << iterations << " requests");
+    CHECK(median(check_s) / median(parse_s) <= max_validation_ratio);
+}
@@ -0,0 +1,308 @@
+#include "proxy.hpp"
+#include "proxy_fabric.hpp"
+
+#include "support/logging.hpp"
+#include "support/stand_in_node.hpp"
+#include "support/ws_client.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <future>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    auto make_request(int id, std::string const& method = "embedded.pillar.getAll", std::string params = "[0, 1]")
+    {
+        return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) + R"(,"method":")" + method +
+               R"(","params":)" + params + "}";
+    }
+
+    auto id_of(std::optional<std::string> const& response)
+    {
+        REQUIRE(response);
+        return nlohmann::json::parse(*response).at("id").get<int>();
+    }
+
+    // a plain listening socket without SO_REUSEPORT, blocking the port for uWS
+    class occupied_port
+    {
+        int fd_;
+        uint16_t port_{};
+
+    public:
+        occupied_port() : fd_{::socket(AF_INET, SOCK_STREAM, 0)}
+        {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_ANY);
+            ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            ::listen(fd_, 1);
+
+            socklen_t length = sizeof(addr);
+            ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &length);
+            port_ = ntohs(addr.sin_port);
+        }
+
+        ~occupied_port() { ::close(fd_); }
+
+        auto port() const { return port_; }
+    };
+} // namespace
+
+TEST_CASE("startup fails without a reachable node", "[proxy][startup]")
+{
+    reverse::test::start_logging();
+
+    // port 1 (tcpmux) is not expected to accept connections; the handler gives up after its retry period
+    reverse::proxy proxy{0, 0, "ws://127.0.0.1", 1};
+    CHECK_THROWS_AS(proxy.ws(20), reverse::proxy_error);
+}
+
+TEST_CASE("startup fails if the public port is taken", "[proxy][startup]")
+{
+    reverse::test::start_logging();
+    reverse::test::stand_in_node node;
+    occupied_port taken;
+
+    reverse::proxy proxy{0, taken.port(), node.url(), node.port()};
+    CHECK_THROWS_AS(proxy.ws(20), reverse::proxy_error);
+}
+
+TEST_CASE("startup fails for wss without readable certificates", "[proxy][startup]")
+{
+    reverse::test::start_logging();
+    reverse::test::stand_in_node node;
+
+    reverse::proxy proxy{0, 0, node.url(), node.port()};
+    CHECK_THROWS_AS(proxy.wss(20, "/nonexistent/privkey.pem", "/nonexistent/fullchain.pem"), reverse::proxy_error);
+}
+
+TEST_CASE("the fabric reports failed proxies", "[proxy][startup]")
+{
+    reverse::test::start_logging();
+    reverse::test::stand_in_node node;
+    occupied_port taken;
+
+    reverse::proxy_opts opts;
+    opts.znn_node_url = node.url();
+    opts.znn_node_port = node.port();
+    opts.timeout = 50;
+
+    reverse::proxy_fabric fabric;
+
+    opts.public_port = 0;
+    auto const [started, id] = fabric.add_proxy(reverse::proto::ws, opts);
+    CHECK(started);
+    CHECK(id == 0);
+
+    opts.public_port = taken.port();
+    CHECK_FALSE(fabric.add_proxy(reverse::proto::ws, opts).first);
+
+    fabric.close();
+}
+
+TEST_CASE("requests are forwarded and answered", "[proxy]")
+{
+    reverse::test::start_logging();
+    reverse::test::stand_in_node node;
+    reverse::proxy proxy{0, 0, node.url(), node.port()};
+    proxy.ws(100);
+
+    {
+        reverse::test::ws_client client{proxy.port()};
+        for (int id = 1; id <= 10; id++)
+        {
+            auto const response = client.request(make_request(id));
+            CHECK(id_of(response) == id);
+            CHECK(nlohmann::json::parse(*response).at("result") == "embedded.pillar.getAll");
+        }
+    }
+
+    proxy.close();
+}
+
+TEST_CASE("responses arriving after the timeout are discarded", "[proxy][timeout]")
+{
+    reverse::test::start_logging();
+    reverse::test::stand_in_node node;
+    reverse::proxy proxy{0, 0, node.url(), node.port()};
+    proxy.ws(20);
+
+    {
+        reverse::test::ws_client client{proxy.port()};
+
+        client.send(make_request(1, "test.sleep", "[200]"));
+        CHECK_FALSE(client.receive(500ms));
+
+        // the proxy keeps serving the connection afterwards
+        CHECK(id_of(client.request(make_request(2))) == 2);
+    }
+
+    proxy.close();
+}
+
+TEST_CASE("concurrent clients receive their own responses", "[proxy][concurrency]")
+{
+    reverse::test::start_logging();
+    reverse::test::stand_in_node node;
+    reverse::proxy proxy{0, 0, node.url(), node.port()};
+    proxy.ws(200);
+
+    constexpr int clients = 8;
+    constexpr int requests = 50;
+
+    std::vector<std::future<int>> results;
+    for (int c = 0; c < clients; c++)
+    {
+        results.push_back(std::async(std::launch::async, [&proxy, c] {
+            reverse::test::ws_client client{proxy.port()};
+            int matched{};
+            for (int r = 0; r < requests; r++)
+            {
+                auto const id = c * requests + r;
+                auto const response = client.request(make_request(id));
+                if (response && nlohmann::json::parse(*response).at("id") == id) matched++;
+            }
+            return matched;
+        }));
+    }
+
+    for (auto&& result : results)
+    {
+        CHECK(result.get() == requests);
+    }
+
+    proxy.close();
+}
+
+TEST_CASE("invalid requests are answered by the proxy itself", "[proxy][validation]")
+{
+    reverse::test::start_logging();
+    reverse::test::stand_in_node node;
+    reverse::proxy proxy{0, 0, node.url(), node.port(), {}, {.enabled = true, .deny = {"test.*"}}};
+    proxy.ws(20);
+
+    {
+        reverse::test::ws_client client{proxy.port()};
+
+        // would block the node for 10s if forwarded
+        auto const denied = client.request(make_request(1, "test.sleep", "[10000]"), 500ms);
+        REQUIRE(denied);
+        CHECK(nlohmann::json::parse(*denied).at("error").at("code") == -32601);
+
+        CHECK(id_of(client.request(make_request(2))) == 2);
+    }
+
+    proxy.close();
+    CHECK(proxy.rejections().at("method_denied") == 1);
+}
+
+TEST_CASE("junk frames do not take the proxy down", "[proxy][validation]")
+{
+    reverse::test::start_logging();
+    reverse::test::stand_in_node node;
+    reverse::proxy proxy{0, 0, node.url(), node.port(), {}, {.enabled = true, .admin = true}};
+    proxy.ws(20);
+
+    {
+        reverse::test::ws_client client{proxy.port()};
+
+        CHECK(client.request(R"({"jsonrpc":2,"id":1,"method":"x"})"));
+        CHECK(client.request(R"({"jsonrpc":"2.0","id":1,"method":5})"));
+        CHECK(client.request(R"({"method":5,"params":["repro.validation.getRejections"]})"));
+
+        CHECK(id_of(client.request(make_request(2))) == 2);
+    }
+
+    proxy.close();
+    CHECK(proxy.rejections().at("invalid_request") == 3);
+}
+
+TEST_CASE("admin methods are answered despite an allowlist", "[proxy][validation][tracing]")
+{
+    reverse::test::start_logging();
+    reverse::test::stand_in_node node;
+    reverse::proxy proxy{0,
+                         0,
+                         node.url(),
+                         node.port(),
+                         {.enabled = true, .admin = true},
+                         {.enabled = true, .allow = {"embedded.*"}, .max_request_bytes = 512, .admin = true}};
+    proxy.ws(100);
+
+    {
+        reverse::test::ws_client client{proxy.port()};
+        CHECK(id_of(client.request(make_request(1))) == 1);
+
+        auto const slowest = client.request(make_request(2, "repro.tracing.getSlowestRequests", "[5]"));
+        CHECK(nlohmann::json::parse(*slowest).at("result").size() == 1);
+
+        // received is taken on arrival, so validating the request counts towards dispatch and total
+        auto const traced = nlohmann::json::parse(*slowest).at("result").at(0);
+        CHECK(traced.at("dispatch_us") >= 0);
+        CHECK(traced.at("total_us") >= traced.at("dispatch_us").get<int64_t>() + traced.at("node_us").get<int64_t>());
+
+        auto const rejections = client.request(make_request(3, "repro.validation.getRejections", "[]"));
+        CHECK(nlohmann::json::parse(*rejections).at("result").at("too_large") == 0);
+
+        // the size limit applies before the admin methods are looked for
+        auto const padded = make_request(4, "repro.validation.getRejections", "[\"" + std::string(600, 'x') + "\"]");
+        CHECK(nlohmann::json::parse(*client.request(padded)).at("error").at("code") == -32600);
+    }
+
+    proxy.close();
+    CHECK(proxy.rejections().at("too_large") == 1);
+}
+
+TEST_CASE("close stops accepting connections", "[proxy][shutdown]")
+{
+    reverse::test::start_logging();
+    reverse::test::stand_in_node node;
+    reverse::proxy proxy{0, 0, node.url(), node.port()};
+    proxy.ws(100);
+    auto const port = proxy.port();
+
+    {
+        reverse::test::ws_client client{port};
+        CHECK(id_of(client.request(make_request(1))) == 1);
+    }
+
+    proxy.close();
+    CHECK_THROWS(reverse::test::ws_client{port});
+}
+
+TEST_CASE("close ends idle connections and returns promptly", "[proxy][shutdown]")
+{
+    reverse::test::start_logging();
+    reverse::test::stand_in_node node;
+    reverse::proxy proxy{0, 0, node.url(), node.port()};
+    proxy.ws(100);
+
+    std::vector<std::unique_ptr<reverse::test::ws_client>> clients;
+    for (int id = 1; id <= 3; id++)
+    {
+        clients.push_back(std::make_unique<reverse::test::ws_client>(proxy.port()));
+        CHECK(id_of(clients.back()->request(make_request(id))) == id);
+    }
+
+    auto closed = std::async(std::launch::async, [&proxy] { proxy.close(); });
+
+    // the clients only answer the close frame, as any websocket library does
+    for (auto&& client : clients)
+    {
+        CHECK_FALSE(client->receive(1s));
+        CHECK_FALSE(client->connected());
+    }
+
+    CHECK(closed.wait_for(1s) == std::future_status::ready);
+}
@@ -0,0 +1,103 @@
+#include "tracing.hpp"
+
+#include "support/logging.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    auto finish_after(reverse::tracing::tracer& tracer, std::chrono::microseconds duration)
+    {
+        auto record = tracer.begin(10, reverse::tracing::clock::now());
+        record.dispatched = record.upstream_sent = record.received;
+        record.upstream_received = record.received + duration / 2;
+        record.written = record.received + duration;
+        tracer.finish(record);
+        return record.id;
+    }
+} // namespace
+
+TEST_CASE("the slowest requests of the recent window are reported", "[tracing]")
+{
+    reverse::test::start_logging();
+    reverse::tracing::tracer tracer{0, {.enabled = true, .slow_ms = 1000, .window = 3}};
+
+    finish_after(tracer, std::chrono::microseconds(900)); // falls out of the window
+    auto const slow = finish_after(tracer, std::chrono::microseconds(300));
+    finish_after(tracer, std::chrono::microseconds(100));
+    auto const slowest = finish_after(tracer, std::chrono::microseconds(500));
+
+    auto const top = tracer.slowest(2);
+    REQUIRE(top.size() == 2);
+    CHECK(top[0].id == slowest);
+    CHECK(top[1].id == slow);
+    CHECK(reverse::tracing::total_us(top[0]) == 500);
+
+    CHECK(tracer.slowest(10).size() == 3);
+}
+
+TEST_CASE("phases that were never reached are reported as -1", "[tracing]")
+{
+    reverse::test::start_logging();
+    reverse::tracing::tracer tracer{0, {.enabled = true}};
+
+    auto record = tracer.begin(10, reverse::tracing::clock::now());
+    record.dispatched = record.received;
+    record.result = reverse::tracing::status::timeout;
+
+    auto const json = reverse::tracing::to_json(record);
+    CHECK(json.at("status") == "timeout");
+    CHECK(json.at("dispatch_us") == 0);
+    CHECK(json.at("node_us") == -1);
+    CHECK(json.at("total_us") == -1);
+}
+
+TEST_CASE("the admin method is only answered for matching requests", "[tracing]")
+{
+    reverse::test::start_logging();
+    reverse::tracing::tracer tracer{0, {.enabled = true, .admin = true}};
+    finish_after(tracer, std::chrono::microseconds(100));
+
+    auto const reply = reverse::tracing::handle_admin_request(
+        tracer, R"({"jsonrpc":"2.0","id":3,"method":"repro.tracing.getSlowestRequests","params":[5]})");
+    auto const json = nlohmann::json::parse(reply);
+    CHECK(json.at("id") == 3);
+    CHECK(json.at("result").size() == 1);
+
+    CHECK(reverse::tracing::handle_admin_request(tracer, R"({"method":"embedded.pillar.getAll"})").empty());
+    CHECK(reverse::tracing::handle_admin_request(
+              tracer, R"({"method":"embedded.pillar.getAll","params":["repro.tracing.getSlowestRequests"]})")
+              .empty());
+}
+
+TEST_CASE("malformed tracing admin requests are ignored", "[tracing]")
+{
+    reverse::test::start_logging();
+    reverse::tracing::tracer tracer{0, {.enabled = true, .admin = true}};
+
+    CHECK_NOTHROW(reverse::tracing::handle_admin_request(
+        tracer, R"({"method":5,"params":["repro.tracing.getSlowestRequests"]})"));
+    CHECK(reverse::tracing::handle_admin_request(
+              tracer, R"({"method":5,"params":["repro.tracing.getSlowestRequests"]})")
+              .empty());
+    CHECK(reverse::tracing::handle_admin_request(tracer, R"(["repro.tracing.getSlowestRequests"])").empty());
+
+    auto const padded = R"({"jsonrpc":"2.0","id":1,"method":"repro.tracing.getSlowestRequests","params":[1],"x":")" +
+                        std::string(reverse::admin::max_request_bytes, 'x') + R"("})";
+    CHECK(reverse::tracing::handle_admin_request(tracer, padded).empty());
+}
+
+TEST_CASE("window and query size are bounded", "[tracing]")
+{
+    reverse::test::start_logging();
+    reverse::tracing::tracer tracer{0, {.enabled = true, .window = 1'000'000}};
+
+    for (size_t i{}; i < reverse::tracing::max_window + 10; i++)
+    {
+        finish_after(tracer, std::chrono::microseconds(i));
+    }
+
+    CHECK(tracer.slowest(1'000'000).size() == reverse::tracing::max_slowest);
+    CHECK(reverse::tracing::total_us(tracer.slowest(1).front()) ==
+          static_cast<int64_t>(reverse::tracing::max_window + 9));
+}
@@ -0,0 +1,182 @@
+#include "validation.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+using reverse::validation::reason;
+
+namespace
+{
+    auto request(std::string const& method, std::string const& params)
+    {
+        return R"({"jsonrpc":"2.0","id":7,"method":")" + method + R"(","params":)" + params + "}";
+    }
+
+    constexpr auto address = R"("z1qqjnwjjpnue8xmmpanz6csze6tcmtzzdtfsww7")";
+    constexpr auto hash = R"("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef")";
+} // namespace
+
+TEST_CASE("valid requests pass", "[validation]")
+{
+    reverse::validation::validator validator{{.enabled = true}};
+
+    CHECK_FALSE(validator.check(request("embedded.pillar.getQsrRegistrationCost", "[]")));
+    CHECK_FALSE(validator.check(request("embedded.pillar.getAll", "[0, 10]")));
+    CHECK_FALSE(validator.check(request("ledger.getAccountInfoByAddress", std::string{"["} + address + "]")));
+    CHECK_FALSE(validator.check(request("ledger.getMomentumByHash", std::string{"["} + hash + "]")));
+    CHECK_FALSE(validator.check("[" + request("embedded.pillar.getAll", "[0, 1]") + "]"));
+}
+
+TEST_CASE("addresses and hashes are accepted in either case", "[validation]")
+{
+    reverse::validation::validator validator{{.enabled = true}};
+
+    auto const by_address = [&](std::string const& value) {
+        return validator.check(request("ledger.getAccountInfoByAddress", "[\"" + value + "\"]"));
+    };
+    auto const by_hash = [&](std::string const& value) {
+        return validator.check(request("ledger.getMomentumByHash", "[\"" + value + "\"]"));
+    };
+
+    CHECK_FALSE(by_address("z1qqjnwjjpnue8xmmpanz6csze6tcmtzzdtfsww7"));
+    CHECK_FALSE(by_address("Z1QQJNWJJPNUE8XMMPANZ6CSZE6TCMTZZDTFSWW7"));
+    CHECK(by_address("z1QQjnwjjpnue8xmmpanz6csze6tcmtzzdtfsww7")); // mixed case
+    CHECK(by_address("Z1qqjnwjjpnue8xmmpanz6csze6tcmtzzdtfsww7"));
+    CHECK(by_address("z1qqjnwjjpnue8xmmpanz6csze6tcmtzzdtfsww1")); // '1' is not in the charset
+
+    CHECK_FALSE(by_hash("0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF"));
+    CHECK_FALSE(by_hash("0123456789abcdef0123456789ABCDEF0123456789abcdef0123456789ABCDEF"));
+    CHECK(by_hash("0123456789abcdeg0123456789abcdef0123456789abcdef0123456789abcdef"));
+}
+
+TEST_CASE("malformed requests are rejected with the matching reason", "[validation]")
+{
+    reverse::validation::validator validator{{.enabled = true, .max_request_bytes = 256}};
+
+    auto const why = [&](std::string const& message) {
+        auto const result = validator.check(message);
+        REQUIRE(result);
+        return result->why;
+    };
+
+    CHECK(why(std::string(257, ' ')) == reason::too_large);
+    CHECK(why(R"({"jsonrpc":)") == reason::parse_error);
+    CHECK(why("[]") == reason::invalid_request);
+    CHECK(why("42") == reason::invalid_request);
+    CHECK(why(R"({"id":1,"method":"ledger.getMomentumsByPage","params":[0,1]})") == reason::invalid_request);
+    CHECK(why(request("embedded.pillar.getAll", "[0, 1025]")) == reason::invalid_params);
+    CHECK(why(request("embedded.pillar.getAll", "[0]")) == reason::invalid_params);
+    CHECK(why(request("embedded.pillar.getAll", "[-1, 10]")) == reason::invalid_params);
+    CHECK(why(request("ledger.getAccountInfoByAddress", R"(["z1short"])")) == reason::invalid_params);
+    CHECK(why(request("ledger.getMomentumByHash", R"(["0123"])")) == reason::invalid_params);
+    CHECK(why(request("stats.osInfo", "7")) == reason::invalid_params);
+    CHECK(why(R"({"jsonrpc":2,"id":1,"method":"x"})") == reason::invalid_request);
+    CHECK(why(R"({"jsonrpc":"2.0","id":1,"method":5})") == reason::invalid_request);
+    CHECK(why(R"({"jsonrpc":null,"id":1,"method":["x"]})") == reason::invalid_request);
+
+    CHECK(validator.rejections(reason::invalid_params) == 6);
+    CHECK(validator.rejections_json().at("too_large") == 1);
+}
+
+TEST_CASE("method allow- and denylists", "[validation]")
+{
+    reverse::validation::validator validator{
+        {.enabled = true, .allow = {"embedded.*", "stats.syncInfo"}, .deny = {"embedded.swap.*"}}};
+
+    CHECK_FALSE(validator.check(request("embedded.pillar.getAll", "[0, 1]")));
+    CHECK_FALSE(validator.check(request("stats.syncInfo", "[]")));
+    CHECK(validator.check(request("stats.osInfo", "[]"))->why == reason::method_denied);
+    CHECK(validator.check(request("embedded.swap.getAssets", "[]"))->why == reason::method_denied);
+    CHECK(validator.check(request("embeddedX.pillar.getAll", "[0, 1]"))->why == reason::method_denied);
+}
+
+TEST_CASE("rejections are answered with JSON-RPC errors", "[validation]")
+{
+    reverse::validation::validator validator{{.enabled = true, .deny = {"stats.*"}}};
+
+    auto const rejection = validator.check(request("stats.osInfo", "[]"));
+    REQUIRE(rejection);
+    auto const denied = nlohmann::json::parse(reverse::validation::make_error(*rejection));
+    CHECK(denied.at("id") == 7);
+    CHECK(denied.at("error").at("code") == -32601);
+
+    auto const unparsable = nlohmann::json::parse(reverse::validation::make_error(*validator.check("{")));
+    CHECK(unparsable.at("id").is_null());
+    CHECK(unparsable.at("error").at("code") == -32700);
+}
+
+TEST_CASE("the size limit can be checked on its own", "[validation]")
+{
+    reverse::validation::validator validator{{.enabled = true, .max_request_bytes = 16}};
+
+    CHECK_FALSE(validator.check_size("{}"));
+    CHECK(validator.check_size(std::string(17, '{'))->why == reason::too_large);
+    CHECK(validator.rejections(reason::too_large) == 1);
+}
+
+TEST_CASE("rejected batches are answered with an array", "[validation]")
+{
+    reverse::validation::validator validator{{.enabled = true, .deny = {"stats.*"}}};
+
+    auto const batch = "[" + request("embedded.pillar.getAll", "[0, 1]") + "," +
+                       R"({"jsonrpc":"2.0","id":8,"method":"stats.osInfo","params":[]})" + "," +
+                       R"({"jsonrpc":"2.0","method":"embedded.pillar.getAll","params":[0, 1]})" + "]";
+
+    auto const rejection = validator.check(batch);
+    REQUIRE(rejection);
+    CHECK(rejection->why == reason::method_denied);
+    CHECK(validator.rejections(reason::method_denied) == 1);
+    CHECK(validator.rejections(reason::invalid_request) == 0); // the valid requests are not counted
+
+    auto const response = nlohmann::json::parse(reverse::validation::make_error(*rejection));
+    REQUIRE(response.is_array());
+    REQUIRE(response.size() == 2); // the notification is not answered
+    CHECK(response[0].at("id") == 7);
+    CHECK(response[0].at("error").at("code") == -32600);
+    CHECK(response[1].at("id") == 8);
+    CHECK(response[1].at("error").at("code") == -32601);
+
+    auto const notifications = validator.check(R"([{"jsonrpc":"2.0","method":"stats.osInfo"}])");
+    REQUIRE(notifications);
+    CHECK(reverse::validation::make_error(*notifications).empty());
+
+    auto const notification = validator.check(R"({"jsonrpc":"2.0","method":"stats.osInfo"})");
+    REQUIRE(notification);
+    CHECK(reverse::validation::make_error(*notification).empty());
+}
+
+TEST_CASE("each rejected request of a batch is counted under its own reason", "[validation]")
+{
+    reverse::validation::validator validator{{.enabled = true, .deny = {"stats.*"}}};
+
+    std::string batch = "[";
+    for (int i = 0; i < 5; i++)
+    {
+        batch += R"({"jsonrpc":"2.0","id":)" + std::to_string(i) + R"(,"method":"stats.osInfo"},)";
+    }
+    batch += request("embedded.pillar.getAll", "[0, 1025]") + "," + R"({"jsonrpc":"2.0","method":"stats.osInfo"})" +
+             "," + request("embedded.pillar.getAll", "[0, 1]") + "]";
+
+    auto const rejection = validator.check(batch);
+    REQUIRE(rejection);
+    CHECK(validator.rejections(reason::method_denied) == 6); // including the notification
+    CHECK(validator.rejections(reason::invalid_params) == 1);
+    CHECK(validator.rejections(reason::invalid_request) == 0);
+
+    auto const response = nlohmann::json::parse(reverse::validation::make_error(*rejection));
+    CHECK(response.size() == 7);
+}
+
+TEST_CASE("malformed validation admin requests are ignored", "[validation]")
+{
+    reverse::validation::validator validator{{.enabled = true, .admin = true}};
+
+    CHECK_NOTHROW(reverse::validation::handle_admin_request(
+        validator, R"({"method":5,"params":["repro.validation.getRejections"]})"));
+    CHECK(reverse::validation::handle_admin_request(
+              validator, R"({"method":5,"params":["repro.validation.getRejections"]})")
+              .empty());
+
+    auto const reply = reverse::validation::handle_admin_request(
+        validator, R"({"jsonrpc":"2.0","id":1,"method":"repro.validation.getRejections"})");
+    CHECK(nlohmann::json::parse(reply).at("result").contains("too_large"));
+}